@@ -31,13 +31,42 @@
  * - We will be given large instances of the problem to handle.
  * - Any optimal alignment with the correct edit distance will be accepted.
  *
+ * INSTRUMENTATION:
+ * When compiled with -DSTATS and run with --stats, the program additionally writes a
+ * single JSON object to stderr with the time spent in each phase (read, alloc, fill,
+ * traceback, output) and counters for DP cells computed and bytes allocated for the
+ * table. Without -DSTATS all instrumentation compiles away to nothing.
+ *
  ***************************************************************************************/
 
 #include <iostream>
 #include <vector>
+#include <string>
 
 using namespace std;
 
+/***************************************************************************************
+ * INSTRUMENTATION
+ ***************************************************************************************/
+#ifdef STATS
+namespace stats {
+    // Phases of the program, each timed separately
+    enum Phase { Read, Alloc, Fill, Traceback, Output, NumPhases };
+    const char* phaseNames[NumPhases] = { "read", "alloc", "fill", "traceback", "output" };
+    // Counters tracked over the run
+    enum Counter { DPCells, BytesAllocated, NumCounters };
+    const char* counterNames[NumCounters] = { "dp_cells", "bytes_allocated" };
+}
+// Shared timers, counters and STATS_* macros
+#include "stats.h"
+#else
+// Without -DSTATS the program stays a single file and all instrumentation vanishes
+#define STATS_INIT(argc, argv) ((void)(argc), (void)(argv))
+#define STATS_PHASE(p)
+#define STATS_COUNT(c, k)
+#define STATS_REPORT()
+#endif
+
 // Helper function that returns the minimum of three integer values
 int min3(int n1, int n2, int n3) {
     return min(min(n1, n2), n3);
@@ -57,6 +86,7 @@ int opt(vector<vector<int>>* A, string* x, string* y, int i, int j) {
 
     // Store and return optimal alignment value
     (*A)[i][j] = rec;
+    STATS_COUNT(DPCells, 1);
     return rec;
 }
 
@@ -126,8 +156,10 @@ vector<string> getOptAlignment(vector<vector<int>>* A, string* x, string* y, int
 
 }
 
-int main()
+int main(int argc, char** argv)
 {
+    STATS_INIT(argc, argv);
+
     // As given by the problem, we will be using a gap penalty of 1 and mismatch
     // penalties of 1 for all character pairs, except when those characters are
     // the same, in which case the mismatch penalty is 0.
@@ -135,8 +167,11 @@ int main()
     // Initialize strings
     string x, y;
     // Read in inputs
-    cin >> x;
-    cin >> y;
+    {
+        STATS_PHASE(Read);
+        cin >> x;
+        cin >> y;
+    }
 
     // Get lengths of strings
     int m = x.length();
@@ -144,30 +179,47 @@ int main()
 
     // Construct array A for the optimal values
     vector<vector<int>> A;
-    // Initialize A[i, 0] for each i
-    vector<int> xvec;
-    xvec.assign(n+1, -1);
-    for (int i = 0; i <= m; i++) {
-        xvec[0] = i;
-        A.push_back(xvec);
-    }
-    // Initialize A[0, j] for each j
-    vector<int> yvec;
-    for (int j = 0; j <= n; j++) {
-        yvec.push_back(j);
+    {
+        STATS_PHASE(Alloc);
+        // Initialize A[i, 0] for each i
+        vector<int> xvec;
+        xvec.assign(n+1, -1);
+        for (int i = 0; i <= m; i++) {
+            xvec[0] = i;
+            A.push_back(xvec);
+        }
+        // Initialize A[0, j] for each j
+        vector<int> yvec;
+        for (int j = 0; j <= n; j++) {
+            yvec.push_back(j);
+        }
+        A[0] = yvec;
     }
-    A[0] = yvec;
+    // Payload only: one row per character of x plus the row vectors themselves
+    STATS_COUNT(BytesAllocated, (long long)(m + 1) * ((n + 1) * sizeof(int) + sizeof(vector<int>)));
 
     // Get pointer to A
     vector<vector<int>>* Aptr = &A;
 
     // Get optimal alignment value
-    int optAlignVal = opt(Aptr, &x, &y, m, n);
+    int optAlignVal;
+    {
+        STATS_PHASE(Fill);
+        optAlignVal = opt(Aptr, &x, &y, m, n);
+    }
     // Get optimal alignment itself
-    vector<string> optAlignment = getOptAlignment(Aptr, &x, &y, m, n);
+    vector<string> optAlignment;
+    {
+        STATS_PHASE(Traceback);
+        optAlignment = getOptAlignment(Aptr, &x, &y, m, n);
+    }
 
     // Print output in correct format
-    cout << optAlignVal << endl
-        << optAlignment[0] << endl
-        << optAlignment[1] << endl;
-}
\ No newline at end of file
+    {
+        STATS_PHASE(Output);
+        cout << optAlignVal << endl
+            << optAlignment[0] << endl
+            << optAlignment[1] << endl;
+    }
+    STATS_REPORT();
+}
\ No newline at end of file
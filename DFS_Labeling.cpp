@@ -42,6 +42,14 @@
  * - If DFS does not reach all nodes, we should restart the DFS from the first
  *   unvisited node, creating a DFS forest of [k] trees if we restart [k] times.
  *
+ * INSTRUMENTATION:
+ * When compiled with -DSTATS and run with --stats, the program additionally writes a
+ * single JSON object to stderr with the time spent in each phase (parse, build, dfs,
+ * output) and counters for nodes, edges, edges of each type, and payload bytes
+ * allocated. Parse covers only reading the edge list; build covers the adjacency
+ * lists and the graph copies. Without -DSTATS all instrumentation compiles away to
+ * nothing.
+ *
  ***************************************************************************************/
 
 #include <iostream>
@@ -51,6 +59,30 @@
 
 using namespace std;
 
+/***************************************************************************************
+ * INSTRUMENTATION
+ ***************************************************************************************/
+#ifdef STATS
+namespace stats {
+	// Phases of the program, each timed separately
+	enum Phase { Parse, Build, Search, Output, NumPhases };
+	const char* phaseNames[NumPhases] = { "parse", "build", "dfs", "output" };
+	// Counters tracked over the run
+	enum Counter { Nodes, Edges, TreeEdges, ForwardEdges, BackEdges, CrossEdges,
+		BytesAllocated, NumCounters };
+	const char* counterNames[NumCounters] = { "nodes", "edges", "tree_edges",
+		"forward_edges", "back_edges", "cross_edges", "bytes_allocated" };
+}
+// Shared timers, counters and STATS_* macros
+#include "stats.h"
+#else
+// Without -DSTATS the program stays a single file and all instrumentation vanishes
+#define STATS_INIT(argc, argv) ((void)(argc), (void)(argv))
+#define STATS_PHASE(p)
+#define STATS_COUNT(c, k)
+#define STATS_REPORT()
+#endif
+
 /***************************************************************************************
  * EDGETYPE ENUM DECLARATION
  ***************************************************************************************/
@@ -165,6 +197,7 @@ void Graph::visit(int n) {
 	preorder++;
 	// Add newly-visited node to path
 	DFSpath.push_back(n);
+	STATS_COUNT(BytesAllocated, sizeof(int));
 	if (n == smallestUnvisited) {
 		updateSmallestUnvisited();
 	}
@@ -194,6 +227,16 @@ void Graph::updateEdge(int u, int v) {
 
 	// Set edge as determined type
 	nodes[u].setEdgeType(v, eType);
+	STATS_COUNT(BytesAllocated, sizeof(EdgeType));
+#ifdef STATS
+	switch (eType) {
+	case Tree: STATS_COUNT(TreeEdges, 1); break;
+	case Forward: STATS_COUNT(ForwardEdges, 1); break;
+	case Back: STATS_COUNT(BackEdges, 1); break;
+	case Cross: STATS_COUNT(CrossEdges, 1); break;
+	default: break;
+	}
+#endif
 }
 
 // Prints DFS path
@@ -214,25 +257,43 @@ void Graph::printPath() {
 void buildGraph(Graph* gptr, vector<pair<int, int>>* eptr) {
 	// Get initial input (n, m)
 	int n, m;
-	scanf("%d%d", &n, &m);
+	{
+		STATS_PHASE(Parse);
+		scanf("%d%d", &n, &m);
+	}
 
 	// Get all subsequent inputs (u, v)
 	int u, v;
+	// Iterate through inputs, saving edges in vector
+	{
+		STATS_PHASE(Parse);
+		for (int k = 0; k < m; k++) {
+			scanf("%d%d", &u, &v);
+			eptr->emplace_back(u, v);
+		}
+	}
+
+	STATS_PHASE(Build);
 	// Initialize nodes
 	vector<Node> nodes; // Vector of already-initialized nodes
 	vector<Node>* nodesptr = &nodes;
 
 	nodesptr->assign(n, Node()); // Set vector to correct length, filled with empty nodes
 
-	// Iterate through inputs, defining edges and saving in vector
-	for (int k = 0; k < m; k++) {
-		scanf("%d%d", &u, &v);
-		eptr->emplace_back(u, v);
-		nodes[u].addChild(v);
+	// Iterate through saved edges, defining children in input order
+	for (auto e : *eptr) {
+		nodes[e.first].addChild(e.second);
 	}
+	STATS_COUNT(Nodes, n);
+	STATS_COUNT(Edges, m);
+	// Payload only, ignoring vector growth slack: nodes, edge list, and adjacency lists
+	STATS_COUNT(BytesAllocated, n * sizeof(Node) + m * (sizeof(pair<int, int>) + sizeof(int)));
 
+	// Building the graph copies every node and adjacency list three times: into the
+	// by-value constructor argument, into the graph's member, and into [gptr]
 	Graph g = Graph(nodes, n);
 	*gptr = g;
+	STATS_COUNT(BytesAllocated, 3 * (n * sizeof(Node) + m * sizeof(int)));
 }
 
 // Recursive implementation of DFS, starting from node [n] in graph [graph]
@@ -275,6 +336,7 @@ void output(Graph * gptr, vector<pair<int, int>>* eptr) {
 
 	// Print edges
 	vector <pair<int, int>> edges = *eptr;
+	STATS_COUNT(BytesAllocated, edges.size() * sizeof(pair<int, int>));
 	int u, v;
 	int ind = 0;
 
@@ -309,7 +371,9 @@ void output(Graph * gptr, vector<pair<int, int>>* eptr) {
  * MAIN FUNCTION
  ***************************************************************************************/
 // Executes our problem solution
-int main() {
+int main(int argc, char** argv) {
+	STATS_INIT(argc, argv);
+
 	// Initialize graph
 	Graph g;
 	Graph* gptr = &g;
@@ -320,6 +384,13 @@ int main() {
 
 	// Actual execution
 	buildGraph(gptr, eptr);
-	DFS(gptr, 0);
-	output(gptr, eptr);
-}
\ No newline at end of file
+	{
+		STATS_PHASE(Search);
+		DFS(gptr, 0);
+	}
+	{
+		STATS_PHASE(Output);
+		output(gptr, eptr);
+	}
+	STATS_REPORT();
+}
\ No newline at end of file
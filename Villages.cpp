@@ -24,15 +24,74 @@
  * - Any input will conform exactly to the format described above.
  * - We will be given large instances of the problem to handle.
  *
+ * STREAMING MODE:
+ * Run with --streaming to handle road systems too large for the default mode, which
+ * keeps a std::list node per village on top of the directory. Streaming mode keeps
+ * only a 4-byte disjoint-set entry per village and reads roads from stdin in 1 MiB
+ * blocks without ever storing them, so peak memory is 4n bytes plus the block buffer,
+ * independent of m. Adding --mmap=DIR (which implies --streaming) backs the
+ * disjoint-set array with a memory-mapped file created in DIR and unlinked at once, so
+ * it may exceed physical RAM; plain --mmap uses $TMPDIR, or /tmp if unset. DIR must be
+ * on a disk-backed file system: on tmpfs, as /tmp often is, the file lives in RAM or
+ * swap. The whole file is allocated up front, so a full disk is reported at startup.
+ * Both modes print the same result, as checked by tests/villages_streaming.sh.
+ *
+ * INSTRUMENTATION:
+ * When compiled with -DSTATS and run with --stats, the program additionally writes a
+ * single JSON object to stderr with the time spent in each phase (roads, merge,
+ * output, cleanup) and counters for villages, roads, and payload bytes allocated. The
+ * default mode also counts counties created, villages added, merges of two counties,
+ * and villages relabeled by merges; streaming mode reports these as 0 and the merge
+ * phase as 0. Streaming mode instead counts unions of two disjoint sets, which the
+ * default mode reports as 0. Without -DSTATS all instrumentation compiles away to
+ * nothing.
+ *
  ***************************************************************************************/
 
 #include <iostream>
 #include <list>
 #include <vector>
 #include <set>
+#include <string>
+#include <cstdlib>
+#if defined(__unix__)
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#define HAVE_MMAP
+#endif
 
 using namespace std;
 
+/***************************************************************************************
+ * INSTRUMENTATION
+ ***************************************************************************************/
+#ifdef STATS
+namespace stats {
+	// Phases of the program, each timed separately. Reading and adding roads are timed
+	// together, and merge time is spent inside addRoad, so it is included in roads
+	enum Phase { ReadRoads, Merge, Output, Cleanup, NumPhases };
+	const char* phaseNames[NumPhases] = { "roads", "merge", "output", "cleanup" };
+	// Counters tracked over the run
+	enum Counter { Villages, Roads, CountiesCreated, VillagesAdded, Merges,
+		VillagesRelabeled, Unions, BytesAllocated, NumCounters };
+	const char* counterNames[NumCounters] = { "villages", "roads", "counties_created",
+		"villages_added", "merges", "villages_relabeled", "unions", "bytes_allocated" };
+}
+// Approximate size of one std::list node: the village plus next and previous pointers
+#define LIST_NODE_BYTES (sizeof(int) + 2 * sizeof(void*))
+// Shared timers, counters and STATS_* macros
+#include "stats.h"
+#else
+// Without -DSTATS the program stays a single file and all instrumentation vanishes
+#define STATS_INIT(argc, argv) ((void)(argc), (void)(argv))
+#define STATS_PHASE(p)
+#define STATS_COUNT(c, k)
+#define STATS_REPORT()
+#endif
+
 /***************************************************************************************
  * COUNTY CLASS DECLARATION
  ***************************************************************************************/
@@ -51,11 +110,15 @@ public:
 County::County(int u, int v) {
 	villages.push_back(u);
 	villages.push_back(v);
+	STATS_COUNT(CountiesCreated, 1);
+	STATS_COUNT(BytesAllocated, sizeof(County) + 2 * LIST_NODE_BYTES);
 }
 
 // Adds the village [v] to the county
 void County::addVillage(int v) {
 	villages.push_back(v);
+	STATS_COUNT(VillagesAdded, 1);
+	STATS_COUNT(BytesAllocated, LIST_NODE_BYTES);
 }
 
 // Merges the villages for the current county and the villages at [vptr]
@@ -83,6 +146,8 @@ Region::Region(int n) {
 	villagesRemaining = n;
 	// Initialize directory with all villages unassigned to a county
 	directory.assign(n, NULL);
+	STATS_COUNT(Villages, n);
+	STATS_COUNT(BytesAllocated, n * sizeof(County*));
 }
 
 // Returns the true total number of counties, including single villages
@@ -92,6 +157,9 @@ int Region::getNumCounties() {
 
 // Updates the counties of the region knowing there's a road between villages u, v
 void Region::addRoad(int u, int v) {
+	// A road from a village to itself connects nothing new
+	if (u == v) return;
+
 	// Get counties of both villages
 	County* uCounty = directory[u];
 	County* vCounty = directory[v];
@@ -121,12 +189,15 @@ void Region::addRoad(int u, int v) {
 	}
 	// Else if both villages are in different counties
 	else if (uCounty != vCounty) {
+		STATS_PHASE(Merge);
 		// Get list of villages in vCounty
 		list<int>* vVillages = vCounty->getVillages();
 		// Update directory for all villages formerly in vCounty
 		for (auto v : *vVillages) {
 			directory[v] = uCounty;
 		}
+		STATS_COUNT(Merges, 1);
+		STATS_COUNT(VillagesRelabeled, vVillages->size());
 		// Combine counties by having uCounty absorb vCounty
 		uCounty->mergeCounties(vVillages);
 		// Decrement total number of counties
@@ -150,14 +221,225 @@ void Region::cleanup() {
 	}
 }
 
+/***************************************************************************************
+ * COMPACT REGION CLASS DECLARATION
+ ***************************************************************************************/
+ // Represents all villages in the region as a disjoint-set forest using one int per
+ // village. Entries are stored offset by one so that zero-filled memory is a valid
+ // starting state: a positive entry is (parent village + 1), and a non-positive entry
+ // marks the root of a county whose size is (1 - entry).
+class CompactRegion {
+	int* parent = NULL; // Disjoint-set entries, in the encoding described above
+	int numCounties; // Total number of counties in the region, including single villages
+	size_t bytes; // Size in bytes of the array at [parent]
+	vector<int> storage; // Backing store for [parent] when not memory-mapped
+	bool mapped = false; // Whether [parent] is a memory-mapped temporary file
+public:
+	CompactRegion(int n, const char* mmapDir);
+	int getNumCounties() { return numCounties; } // Getter for number of counties
+	int findCounty(int v);
+	void addRoad(int u, int v);
+	void cleanup();
+};
+
+#ifdef HAVE_MMAP
+// Reports that step [what] of setting up the --mmap file at [path] failed with error
+// [err], then exits, since falling back to RAM would defeat the purpose of --mmap
+void mmapFailed(const char* what, const string& path, int err) {
+	fprintf(stderr, "--mmap: cannot %s %s: %s\n", what, path.c_str(), strerror(err));
+	exit(1);
+}
+#endif
+
+// Constructor for a new region with [n] villages, each in a county of its own. If
+// [mmapDir] is not NULL, the array is backed by a file in that directory so it may
+// exceed RAM
+CompactRegion::CompactRegion(int n, const char* mmapDir) {
+	numCounties = n;
+	bytes = (size_t)n * sizeof(int);
+#ifdef HAVE_MMAP
+	if (mmapDir != NULL && n > 0) {
+		// Create the backing file and unlink it at once, so it is removed on any exit
+		string path = string(mmapDir) + "/villages-XXXXXX";
+		int fd = mkstemp(&path[0]);
+		if (fd < 0) { mmapFailed("create", path, errno); }
+		unlink(path.c_str());
+		// Allocate every block now, so a full disk fails here instead of with SIGBUS
+		// partway through. Allocated blocks read as zeros, the starting state we need
+		int err = posix_fallocate(fd, 0, bytes);
+		if (err != 0) { mmapFailed("allocate", path, err); }
+		void* addr = mmap(NULL, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+		if (addr == MAP_FAILED) { mmapFailed("map", path, errno); }
+		// The mapping keeps the file alive after its descriptor is closed
+		close(fd);
+		parent = (int*)addr;
+		mapped = true;
+	}
+#else
+	if (mmapDir != NULL && n > 0) {
+		fprintf(stderr, "--mmap unavailable, keeping disjoint sets in memory\n");
+	}
+#endif
+	if (!mapped) {
+		storage.assign(n, 0);
+		parent = storage.data();
+	}
+	STATS_COUNT(Villages, n);
+	STATS_COUNT(BytesAllocated, bytes);
+}
+
+// Returns the root village of the county containing [v], halving the path on the way
+// by pointing every other village at its grandparent
+int CompactRegion::findCounty(int v) {
+	while (parent[v] > 0) {
+		int p = parent[v] - 1;
+		if (parent[p] > 0) { parent[v] = parent[p]; } // Point v at its grandparent
+		v = parent[v] - 1; // Continue from the grandparent, or from p if it is the root
+	}
+	return v;
+}
+
+// Updates the counties of the region knowing there's a road between villages u, v
+void CompactRegion::addRoad(int u, int v) {
+	int uRoot = findCounty(u);
+	int vRoot = findCounty(v);
+	if (uRoot == vRoot) return;
+
+	// Have the larger county absorb the smaller one, so trees stay shallow
+	if (parent[uRoot] > parent[vRoot]) { swap(uRoot, vRoot); }
+	parent[uRoot] += parent[vRoot] - 1;
+	parent[vRoot] = uRoot + 1;
+	numCounties--;
+	STATS_COUNT(Unions, 1);
+}
+
+// Releases the disjoint-set array. Should only be called at the very end of the
+// program, when the region is no longer going to be used
+void CompactRegion::cleanup() {
+#ifdef HAVE_MMAP
+	if (mapped) { munmap(parent, bytes); }
+#endif
+	parent = NULL;
+	vector<int>().swap(storage);
+}
+
+/***************************************************************************************
+ * ROAD STREAM CLASS DECLARATION
+ ***************************************************************************************/
+ // Reads non-negative integers from stdin in large sequential blocks, so that input
+ // of any length is parsed through a buffer of fixed size
+class RoadStream {
+	vector<char> buffer; // Current block of input
+	size_t length = 0; // Number of valid bytes in [buffer]
+	size_t pos = 0; // Position of the next unread byte in [buffer]
+	bool refill();
+public:
+	RoadStream(size_t blockSize) { buffer.resize(blockSize); }
+	size_t getBlockSize() { return buffer.size(); } // Getter for size of each block
+	bool readInt(int* k);
+};
+
+// Reads the next block of input into the buffer, returning false at end of input
+bool RoadStream::refill() {
+	length = fread(buffer.data(), 1, buffer.size(), stdin);
+	pos = 0;
+	return (length > 0);
+}
+
+// Reads the next integer from the input into [k], returning false at end of input
+bool RoadStream::readInt(int* k) {
+	// Skip whitespace up to the first digit
+	for (;;) {
+		if (pos == length && !refill()) return false;
+		if (buffer[pos] >= '0' && buffer[pos] <= '9') break;
+		pos++;
+	}
+	// Accumulate digits, which may continue into the next block
+	int result = 0;
+	for (;;) {
+		if (pos == length && !refill()) break;
+		if (buffer[pos] < '0' || buffer[pos] > '9') break;
+		result = result * 10 + (buffer[pos] - '0');
+		pos++;
+	}
+	*k = result;
+	return true;
+}
+
+/***************************************************************************************
+ * HELPER FUNCTIONS
+ ***************************************************************************************/
+ // Solves the problem in streaming mode, never storing the roads and keeping only a
+ // compact disjoint-set array, memory-mapped from a file in [mmapDir] if it is not NULL
+void solveStreaming(const char* mmapDir) {
+	// Roads are read in 1 MiB blocks
+	RoadStream input = RoadStream(1 << 20);
+	STATS_COUNT(BytesAllocated, input.getBlockSize());
+
+	// Get initial input (n, m)
+	int n = 0, m = 0;
+	input.readInt(&n);
+	input.readInt(&m);
+	STATS_COUNT(Roads, m);
+
+	// Initialize region
+	CompactRegion reg = CompactRegion(n, mmapDir);
+
+	// Stream each road straight into the region
+	int u, v;
+	{
+		STATS_PHASE(ReadRoads);
+		for (int k = 0; k < m; k++) {
+			input.readInt(&u);
+			input.readInt(&v);
+			reg.addRoad(u, v);
+		}
+	}
+
+	{
+		STATS_PHASE(Output);
+		printf("%d\n", reg.getNumCounties() - 1);
+	}
+
+	{
+		STATS_PHASE(Cleanup);
+		reg.cleanup();
+	}
+}
+
 /***************************************************************************************
  * MAIN FUNCTION
  ***************************************************************************************/
-int main() {
+int main(int argc, char** argv) {
+	STATS_INIT(argc, argv);
+
+	// Check for streaming mode, where --mmap and --mmap=DIR imply --streaming
+	bool streaming = false;
+	bool useMmap = false;
+	string mmapDir;
+	for (int k = 1; k < argc; k++) {
+		string arg = argv[k];
+		if (arg == "--streaming") { streaming = true; }
+		if (arg == "--mmap" || arg.compare(0, 7, "--mmap=") == 0) {
+			streaming = true;
+			useMmap = true;
+			// Without an explicit directory, use $TMPDIR or /tmp
+			const char* tmpdir = getenv("TMPDIR");
+			if (arg.size() > 7) { mmapDir = arg.substr(7); }
+			else { mmapDir = (tmpdir != NULL && *tmpdir) ? tmpdir : "/tmp"; }
+		}
+	}
+	if (streaming) {
+		solveStreaming(useMmap ? mmapDir.c_str() : NULL);
+		STATS_REPORT();
+		return 0;
+	}
+
 	// Get initial input (n, m)
 	// n = number of villages, m = number of currently existing roads
 	int n, m;
 	scanf("%d%d", &n, &m);
+	STATS_COUNT(Roads, m);
 
 	// Initialize region
 	Region reg = Region(n);
@@ -167,15 +449,25 @@ int main() {
 	int u, v;
 
 	// Iterate through subsequent inputs and add corresponding roads to region
-	for (int k = 0; k < m; k++) {
-		scanf("%d%d", &u, &v);
-		reg.addRoad(u, v);
+	{
+		STATS_PHASE(ReadRoads);
+		for (int k = 0; k < m; k++) {
+			scanf("%d%d", &u, &v);
+			reg.addRoad(u, v);
+		}
 	}
 
 	// Minimum number of roads needed is given by the number of roads needed to connect
 	// all counties, which is given by getNumCounties() - 1, so we will print that result
-	printf("%d\n", reg.getNumCounties() - 1);
+	{
+		STATS_PHASE(Output);
+		printf("%d\n", reg.getNumCounties() - 1);
+	}
 
 	// Deallocate any remaining pointers
-	reg.cleanup();
-}
\ No newline at end of file
+	{
+		STATS_PHASE(Cleanup);
+		reg.cleanup();
+	}
+	STATS_REPORT();
+}
\ No newline at end of file
@@ -0,0 +1,70 @@
+/***************************************************************************************
+ * INSTRUMENTATION
+ ***************************************************************************************
+ * Shared phase timers and counters for the programs in this repository. Programs
+ * include this header only when built with -DSTATS, and running that build with
+ * --stats writes a single JSON object to stderr at the end of the run. Without -DSTATS
+ * each program defines the STATS_* macros as empty itself, so it still builds as a
+ * single file.
+ *
+ * Before including this header, a program declares in namespace stats the enums
+ * [Phase] and [Counter], ending in [NumPhases] and [NumCounters], and the name tables
+ * [phaseNames] and [counterNames] used for the report.
+ *
+ ***************************************************************************************/
+
+#ifndef STATS_H
+#define STATS_H
+
+#include <chrono>
+#include <cstdio>
+#include <string>
+
+namespace stats {
+	long long phaseNs[NumPhases] = {}; // Accumulated nanoseconds per phase
+	long long counters[NumCounters] = {}; // Current value of each counter
+	bool enabled = false; // Whether --stats was passed on the command line
+
+	// Adds the time spent in the enclosing scope to phase [p], using the monotonic clock.
+	// Does nothing unless --stats was passed
+	class PhaseTimer {
+		Phase phase;
+		std::chrono::steady_clock::time_point start;
+	public:
+		PhaseTimer(Phase p) : phase(p) {
+			if (enabled) { start = std::chrono::steady_clock::now(); }
+		}
+		~PhaseTimer() {
+			if (!enabled) return;
+			phaseNs[phase] += std::chrono::duration_cast<std::chrono::nanoseconds>(
+				std::chrono::steady_clock::now() - start).count();
+		}
+	};
+
+	// Enables timing and reporting if --stats is among the command line arguments
+	void init(int argc, char** argv) {
+		for (int k = 1; k < argc; k++) {
+			if (std::string(argv[k]) == "--stats") { enabled = true; }
+		}
+	}
+
+	// Writes all phase times and counters to stderr as a single JSON object
+	void report() {
+		if (!enabled) return;
+		fprintf(stderr, "{\"phases_ns\": {");
+		for (int k = 0; k < NumPhases; k++) {
+			fprintf(stderr, "%s\"%s\": %lld", k ? ", " : "", phaseNames[k], phaseNs[k]);
+		}
+		fprintf(stderr, "}, \"counters\": {");
+		for (int k = 0; k < NumCounters; k++) {
+			fprintf(stderr, "%s\"%s\": %lld", k ? ", " : "", counterNames[k], counters[k]);
+		}
+		fprintf(stderr, "}}\n");
+	}
+}
+#define STATS_INIT(argc, argv) stats::init(argc, argv)
+#define STATS_PHASE(p) stats::PhaseTimer statsTimer(stats::p)
+#define STATS_COUNT(c, k) (stats::counters[stats::c] += (k))
+#define STATS_REPORT() stats::report()
+
+#endif
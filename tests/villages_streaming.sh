@@ -0,0 +1,61 @@
+#!/usr/bin/env bash
+# Checks that Villages prints the same count in its default, --streaming, --mmap and
+# --mmap=DIR modes, on hand-picked edge cases and on generated road systems that
+# include self-loops and duplicate roads. The --mmap modes must also actually map
+# their file rather than fall back to memory.
+#
+# Usage: tests/villages_streaming.sh [number of generated inputs, default 200]
+# The compiler can be overridden with CXX.
+
+set -eu
+
+root="$(cd "$(dirname "$0")/.." && pwd)"
+work="$(mktemp -d)"
+trap 'rm -rf "$work"' EXIT
+
+"${CXX:-g++}" -O2 -Wall -Wextra -o "$work/villages" "$root/Villages.cpp"
+
+failures=0
+
+# Runs every mode on the input file [$1] and reports any disagreement or fallback
+check() {
+	local expected actual mode
+	expected="$("$work/villages" < "$1")"
+	for mode in --streaming --mmap "--mmap=$work"; do
+		actual="$("$work/villages" "$mode" < "$1" 2> "$work/err")"
+		if [ "$actual" != "$expected" ]; then
+			echo "FAIL $2: default printed $expected, $mode printed $actual"
+			failures=$((failures + 1))
+		fi
+		if grep -q -- "--mmap unavailable" "$work/err"; then
+			echo "FAIL $2: $mode fell back to memory"
+			failures=$((failures + 1))
+		fi
+	done
+}
+
+# Edge cases: no villages, no roads, a self-loop, a duplicate road, one county
+printf '0 0\n' > "$work/in"; check "$work/in" "empty region"
+printf '5 0\n' > "$work/in"; check "$work/in" "no roads"
+printf '3 1\n0 0\n' > "$work/in"; check "$work/in" "self-loop"
+printf '4 3\n0 1\n1 0\n0 1\n' > "$work/in"; check "$work/in" "duplicate roads"
+printf '4 3\n0 1\n2 3\n1 2\n' > "$work/in"; check "$work/in" "single county"
+
+# Generated road systems with random n, m and endpoints
+count="${1:-200}"
+for seed in $(seq 1 "$count"); do
+	awk -v seed="$seed" 'BEGIN {
+		srand(seed)
+		n = 1 + int(rand() * 300)
+		m = int(rand() * 400)
+		print n, m
+		for (k = 0; k < m; k++) print int(rand() * n), int(rand() * n)
+	}' > "$work/in"
+	check "$work/in" "seed $seed"
+done
+
+if [ "$failures" -ne 0 ]; then
+	echo "$failures mismatches"
+	exit 1
+fi
+echo "all modes agree"